@@ -1,14 +1,56 @@
+#pragma once
 #ifndef std
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
 #endif
 #define __RTT template<typename R> // Macro defining a template alias for types used in the Range class
 #define NULL_Range Range<R>(R(),R())   // Macro defining a default null range value
 
+/*
+@brief Steps a value to its neighbour for Range<R>::Predecessor and Range<R>::Successor.
+Types with no notion of a neighbouring value (e.g. std::string) keep the value unchanged.
+*/
+template<typename R, typename Enable = void>
+struct RangeAdjacent
+{
+    static R Predecessor(R v) { return v; }
+    static R Successor(R v) { return v; }
+};
+
+/*
+@brief Integers step by one in the unsigned type, so the lowest and highest values wrap instead of overflowing.
+*/
+__RTT
+struct RangeAdjacent<R, typename std::enable_if<std::is_integral<R>::value && !std::is_same<R, bool>::value>::type>
+{
+    typedef typename std::make_unsigned<R>::type U;
+    static R Predecessor(R v) { return (R)((U)v - 1); }
+    static R Successor(R v) { return (R)((U)v + 1); }
+};
+
+/*
+@brief Floating point values step to the next representable value.
+*/
+__RTT
+struct RangeAdjacent<R, typename std::enable_if<std::is_floating_point<R>::value>::type>
+{
+    static R Predecessor(R v) { return std::nextafter(v, -std::numeric_limits<R>::infinity()); }
+    static R Successor(R v) { return std::nextafter(v, std::numeric_limits<R>::infinity()); }
+};
+
+/*
+Ranges are closed: both Begin and End belong to the range, so Range(1, 5) holds 1, 2, 3, 4 and 5.
+Intersection, Union, Difference and IsContain follow this rule; the iterators stop before End.
+*/
 __RTT
 class Range
 {
 public:
     R Begin, End;  // Public member variables for the beginning and end of the range
+    bool Empty = false;  // True when the range holds no values (e.g. the intersection of disjoint ranges)
 
     class Iterator
     {
@@ -187,29 +229,67 @@ public:
     */
     ~Range() {};  
 
+    /*
+    @brief Returns a range that holds no values.
+    @return An empty range.
+    */
+    static Range EmptyRange();  
+
+    /*
+    @brief Returns the value just below v (v - 1 for integers, the next representable value for floating point,
+    v itself for types without neighbouring values). Integers wrap around at the lowest value.
+    @param v The value.
+    @return The predecessor of v.
+    */
+    static R Predecessor(R v);  
+
+    /*
+    @brief Returns the value just above v (v + 1 for integers, the next representable value for floating point,
+    v itself for types without neighbouring values). Integers wrap around at the highest value.
+    @param v The value.
+    @return The successor of v.
+    */
+    static R Successor(R v);  
+
+    /*
+    @brief Checks if the range holds no values.
+    @return True if the range is empty, false otherwise.
+    */
+    bool IsEmpty();  
+
     /*
     @brief Returns the intersection of this range and t.
     @param t The range to intersect with.
-    @return A new range representing the intersection.
+    @return A new range representing the intersection, or an empty range if they do not overlap.
     */
     Range Intersection(Range t);  
 
     /*
     @brief Returns the union of this range and t if they intersect.
     @param t The range to union with.
-    @return A new range representing the union or NULL_Range if no intersection.
+    @return A new range representing the union, or an empty range if they do not overlap.
     */
     Range Union(Range t);  
 
     /*
-    @brief Returns the difference between this range and t.
+    @brief Returns the values of this range that are not in t (e.g. Range(1, 5) - Range(4, 8) is Range(1, 3)).
+    If t lies strictly inside this range only the lower remainder is returned; use Difference(t, upper) to get both.
     @param t The range to find the difference with.
-    @return A new range representing the difference.
+    @return A new range representing the difference, or an empty range if t covers this range.
     */
     Range Difference(Range t);  
 
     /*
-    @brief Checks if two ranges are equal.
+    @brief Returns the values of this range that are not in t, in up to two pieces.
+    When t lies strictly inside this range, the lower remainder is returned and the upper one is stored in upper.
+    @param t The range to find the difference with.
+    @param upper Receives the upper remainder, or an empty range if there is none.
+    @return The lower (or only) remainder, or an empty range if t covers this range.
+    */
+    Range Difference(Range t, Range &upper);  
+
+    /*
+    @brief Checks if two ranges are equal (all empty ranges are equal to each other).
     @param t The range to compare with.
     @return True if ranges are equal, false otherwise.
     */
@@ -265,7 +345,7 @@ public:
     bool operator<(Range t);  
 
     /*
-    @brief Updates this range with the intersection of this and t.
+    @brief Updates this range with the intersection of this and t (empty if they do not overlap).
     @param t The range to intersect with.
     */
     void operator&=(Range t);  
@@ -291,7 +371,7 @@ public:
     Range operator||(Range t);  
 
     /*
-    @brief Changes the beginning of the range (must be less than or equal to End).
+    @brief Changes the beginning of the range (must be less than or equal to End; no-op on an empty range).
     @param begin The new beginning value.
     */
     void ChangeBegin(R begin);  
@@ -303,7 +383,7 @@ public:
     void MoveBegin(R begin);  
 
     /*
-    @brief Changes the end of the range (must be greater than or equal to Begin).
+    @brief Changes the end of the range (must be greater than or equal to Begin; no-op on an empty range).
     @param end The new end value.
     */
     void ChangeEnd(R end);  
@@ -348,7 +428,7 @@ public:
 
     /*
     @brief Returns the length of the range.
-    @return The length of the range.
+    @return The length of the range, or 0 if the range is empty.
     */
     R length();  
 
@@ -389,6 +469,14 @@ public:
     @return An iterator at the end of the range.
     */
     typename Range<R>::Iterator end();  
+
+private:
+    /*
+    @brief Resets the bounds of an empty range to those of EmptyRange() so no inverted bounds leak out.
+    @param r The range to normalize.
+    @return The range with normalized bounds.
+    */
+    static Range NormalizeEmpty(Range r);  
 };
 
 __RTT
@@ -400,60 +488,103 @@ Range<R>::Range(R begin, R end)
 }
 
 __RTT
-Range<R> Range<R>::Intersection(Range t)
+Range<R> Range<R>::EmptyRange()
 {
-    // Returns the intersection of this range and t, or NULL_Range if no intersection
-    if (t.End > this->Begin || t.Begin < this->End)
-    {
-        if (this->IsContain(t))  // t is inside this range
-        {
-            return t;
-        }
+    // Returns a range that holds no values
+    Range<R> temp = NULL_Range;
+    temp.Empty = true;
+    return temp;
+}
 
-        if (t.IsContain(*this))  // this range is inside t
-        {
-            return *this;
-        }
-        
-        if (t.Begin <= this->End && t.Begin >= this->Begin)  // Right overlap
-        {
-            return Range<R>(t.Begin, this->End);
-        }
+__RTT
+Range<R> Range<R>::NormalizeEmpty(Range r)
+{
+    // Selects R() for both bounds of an empty range without branching
+    r.Begin = r.Empty ? R() : r.Begin;
+    r.End = r.Empty ? R() : r.End;
+    return r;
+}
 
-        if (t.End >= this->Begin && t.End <= this->End)  // Left overlap
-        {
-            return Range<R>(this->Begin, t.End);
-        }
-    }
-    return NULL_Range;  // No overlap
+__RTT R Range<R>::Predecessor(R v)
+{
+    // Returns the value just below v
+    return RangeAdjacent<R>::Predecessor(v);
+}
+
+__RTT R Range<R>::Successor(R v)
+{
+    // Returns the value just above v
+    return RangeAdjacent<R>::Successor(v);
+}
+
+__RTT bool Range<R>::IsEmpty()
+{
+    // Checks if the range holds no values
+    return this->Empty;
+}
+
+__RTT
+Range<R> Range<R>::Intersection(Range t)
+{
+    // Returns the intersection of this range and t, or an empty range if no intersection.
+    // Written as min/max so integer types compile to conditional moves instead of branches.
+    Range<R> temp(std::max(this->Begin, t.Begin), std::min(this->End, t.End));
+    temp.Empty = (temp.Begin > temp.End) | this->Empty | t.Empty;
+    return NormalizeEmpty(temp);
 }
 
 __RTT
 Range<R> Range<R>::Union(Range t)
 {
-    // Returns the union of this range and t if they intersect, otherwise returns NULL_Range
-    Range<R> temp = NULL_Range;
-    if (Intersection(t) != temp) {
-        if (this->Begin < t.Begin) temp.Begin = this->Begin;
-        else temp.Begin = t.Begin;
+    // Returns the union of this range and t if they intersect, otherwise returns an empty range.
+    // Union with an empty range yields the other range unchanged.
+    bool disjoint = (std::max(this->Begin, t.Begin) > std::min(this->End, t.End));
+    Range<R> temp(std::min(this->Begin, t.Begin), std::max(this->End, t.End));
+    temp.Begin = this->Empty ? t.Begin : (t.Empty ? this->Begin : temp.Begin);
+    temp.End = this->Empty ? t.End : (t.Empty ? this->End : temp.End);
+    temp.Empty = this->Empty ? t.Empty : (!t.Empty & disjoint);
+    return NormalizeEmpty(temp);
+}
 
-        if (this->End > t.End) temp.End = this->End;
-        else temp.End = t.End;
-    }
+__RTT
+Range<R> Range<R>::Difference(Range t)
+{
+    // Returns the values of this range not in t. Both remainders are computed and the right one selected;
+    // Predecessor/Successor may wrap only for a remainder that is not selected.
+    // A disjoint or empty t leaves this range unchanged; if t covers this range the result is empty.
+    bool hasLower = t.Begin > this->Begin;
+    bool hasUpper = t.End < this->End;
+    bool disjoint = (std::max(this->Begin, t.Begin) > std::min(this->End, t.End)) | t.Empty;
+    Range<R> temp(hasLower ? this->Begin : std::max(this->Begin, Successor(t.End)),
+                  hasLower ? std::min(this->End, Predecessor(t.Begin)) : this->End);
+    temp.Begin = disjoint ? this->Begin : temp.Begin;
+    temp.End = disjoint ? this->End : temp.End;
+    temp.Empty = this->Empty | (!disjoint & !hasLower & !hasUpper);
+    return NormalizeEmpty(temp);
+}
 
-    return temp;
+__RTT
+Range<R> Range<R>::Difference(Range t, Range &upper)
+{
+    // Returns the lower (or only) remainder and stores the upper remainder when t splits this range in two
+    bool split = !this->Empty & !t.Empty & (t.Begin > this->Begin) & (t.End < this->End);
+    Range<R> temp(Successor(t.End), this->End);
+    temp.Empty = !split;
+    upper = NormalizeEmpty(temp);
+    return Difference(t);
 }
 
 __RTT bool Range<R>::equal(Range t)
 {
     // Checks if two ranges are equal
+    if (this->Empty | t.Empty) return this->Empty & t.Empty;
     return (t.Begin == this->Begin && t.End == this->End);
 }
 
 __RTT bool Range<R>::IsContain(Range t)
 {
-    // Checks if this range contains the range t
-    return (this->Begin <= t.Begin && this->End >= t.End);
+    // Checks if this range contains the range t (an empty range is contained in every range)
+    return t.Empty | (!this->Empty & (this->Begin <= t.Begin) & (this->End >= t.End));
 }
 
 __RTT bool Range<R>::operator==(Range t)
@@ -495,23 +626,14 @@ __RTT bool Range<R>::operator<(Range t)
 __RTT void Range<R>::operator&=(Range t)
 {
     // Updates this range with the intersection of this and t
-    Range<R> temp = Intersection(t);
-    if (temp != NULL_Range)
-    {
-        this->Begin = temp.Begin;
-        this->End = temp.End;
-    }
+    *this = Intersection(t);
 }
 
 __RTT void Range<R>::operator|=(Range t)
 {
     // Updates this range with the union of this and t
     Range<R> temp = Union(t);
-    if (temp != NULL_Range)
-    {
-        this->Begin = temp.Begin;
-        this->End = temp.End;
-    }
+    if (!temp.IsEmpty()) *this = temp;
 }
 
 __RTT Range<R> Range<R>::operator&&(Range t)
@@ -528,8 +650,8 @@ __RTT Range<R> Range<R>::operator||(Range t)
 
 __RTT void Range<R>::ChangeBegin(R begin)
 {
-    // Changes the beginning of the range (must be less than or equal to End)
-    if (begin <= this->End) this->Begin = begin;
+    // Changes the beginning of the range (must be less than or equal to End); empty ranges have no bounds to change
+    if (!this->Empty && begin <= this->End) this->Begin = begin;
 }
 
 __RTT void Range<R>::MoveBegin(R begin)
@@ -540,8 +662,8 @@ __RTT void Range<R>::MoveBegin(R begin)
 
 __RTT void Range<R>::ChangeEnd(R end)
 {
-    // Changes the end of the range (must be greater than or equal to Begin)
-    if (end >= this->Begin) this->End = end;
+    // Changes the end of the range (must be greater than or equal to Begin); empty ranges have no bounds to change
+    if (!this->Empty && end >= this->Begin) this->End = end;
 }
 
 __RTT void Range<R>::MoveEnd(R end)
@@ -555,13 +677,14 @@ __RTT void Range<R>::operator=(Range t)
     // Overloaded assignment operator to set this range equal to t
     this->Begin = t.Begin;
     this->End = t.End;
+    this->Empty = t.Empty;
 }
 
 __RTT Range<R> Range<R>::operator+(Range t)
 {
     // Overloaded + operator to return the union of this range and t
     Range<R> temp = Union(t);
-    if (temp == NULL_Range)
+    if (temp.IsEmpty())
     {
         return *this;
     }
@@ -571,10 +694,7 @@ __RTT Range<R> Range<R>::operator+(Range t)
 __RTT Range<R> Range<R>::operator-(Range t)
 {
     // Overloaded - operator to return the difference between this range and t
-    R begin = this->Begin, end = this->End;
-    if (t.End < end && t.End >= begin) end = t.End;
-    if (t.Begin > begin && t.Begin <= end) begin = t.Begin;
-    return Range<R>(begin, end);
+    return Difference(t);
 }
 
 __RTT void Range<R>::operator+=(Range t)
@@ -591,8 +711,8 @@ __RTT void Range<R>::operator-=(Range t)
 
 __RTT R Range<R>::length()
 {
-    // Returns the length of the range
-    return this->End - this->Begin;
+    // Returns the length of the range (0 for an empty range)
+    return this->Empty ? R() : (R)(this->End - this->Begin);
 }
 
 __RTT typename Range<R>::Iterator Range<R>::BeginIter()
@@ -642,6 +762,7 @@ __RTT typename Range<R>::Iterator Range<R>::end()
 @return The output stream.
 */
 __RTT std::ostream& operator<<(std::ostream& os, const Range<R>& t) {
+    if (t.Empty) return os << "Range()";
     os << "Range(" << t.Begin << ", " << t.End << ")";
     return os;
 }
\ No newline at end of file
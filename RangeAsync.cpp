@@ -0,0 +1,365 @@
+#pragma once
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <cstdint>
+#include "Range.cpp"
+
+/*
+Coroutine based generators and async streams over Range<R>.
+Requires C++20 (g++ -std=c++20).
+*/
+
+/*
+@brief Shared flag used to cooperatively cancel generators and producers.
+Copies of a token observe the same flag.
+*/
+class RangeCancelToken
+{
+private:
+    std::shared_ptr<bool> cancelled = std::make_shared<bool>(false);  // Flag shared by all copies of the token
+
+public:
+    /*
+    @brief Requests cancellation; generators stop before their next yield.
+    */
+    void Cancel() { *cancelled = true; }
+
+    /*
+    @brief Checks if cancellation has been requested.
+    @return True if cancelled, false otherwise.
+    */
+    bool IsCancelled() const { return *cancelled; }
+};
+
+/*
+@brief Synchronous coroutine generator usable in a range-based for loop.
+@tparam T The type of the yielded values.
+*/
+template<typename T>
+class RangeGenerator
+{
+public:
+    struct promise_type
+    {
+        std::optional<T> value;  // Value handed out by the last co_yield
+
+        RangeGenerator get_return_object() { return RangeGenerator(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value(T v) { value = v; return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    class Iterator
+    {
+    private:
+        std::coroutine_handle<promise_type> handle;  // Generator being iterated
+
+    public:
+        explicit Iterator(std::coroutine_handle<promise_type> h) : handle(h) {}
+        void operator++() { handle.resume(); }
+        T operator*() const { return *handle.promise().value; }
+        bool operator==(std::default_sentinel_t) const { return !handle || handle.done(); }
+    };
+
+    explicit RangeGenerator(std::coroutine_handle<promise_type> h) : handle(h) {}
+    RangeGenerator(RangeGenerator &&t) noexcept : handle(t.handle) { t.handle = nullptr; }
+    RangeGenerator(const RangeGenerator &) = delete;
+    ~RangeGenerator() { if (handle) handle.destroy(); }
+
+    /*
+    @brief Starts the generator and returns an iterator at the first value.
+    @return An iterator at the first value.
+    */
+    Iterator begin() { handle.resume(); return Iterator(handle); }
+
+    /*
+    @brief Returns the end sentinel of the generator.
+    @return The end sentinel.
+    */
+    std::default_sentinel_t end() { return {}; }
+
+private:
+    std::coroutine_handle<promise_type> handle;  // Owned coroutine frame
+};
+
+/*
+@brief Returns how many whole steps fit between v and end without overflowing R.
+@param v The current value (must be less than or equal to end).
+@param end The last value of the range.
+@param step The step size.
+@return The number of further steps that stay inside the range.
+*/
+__RTT uint64_t RangeStepsLeft(R v, R end, R step)
+{
+    if constexpr (std::is_integral_v<R>)
+    {
+        using U = std::make_unsigned_t<R>;
+        return (uint64_t)((U)((U)end - (U)v) / (U)step);
+    }
+    else
+    {
+        return (uint64_t)((end - v) / step);
+    }
+}
+
+/*
+@brief Returns v advanced by n steps, computed in the unsigned type for integers so no intermediate overflows.
+The caller guarantees the result lies inside the range (n <= RangeStepsLeft).
+@param v The starting value.
+@param n Number of steps.
+@param step The step size.
+@return The value n steps after v.
+*/
+__RTT R RangeAdvance(R v, uint64_t n, R step)
+{
+    if constexpr (std::is_integral_v<R>)
+    {
+        using U = std::make_unsigned_t<R>;
+        return (R)((U)v + (U)((U)n * (U)step));
+    }
+    else
+    {
+        return v + (R)n * step;
+    }
+}
+
+/*
+@brief Generates every value of r from Begin to End (inclusive) with the given step.
+@param r The range to iterate.
+@param step The step size (must be positive).
+@param token Cancellation token checked before every yield.
+@return A generator over the values of r; it yields nothing if r is empty or step is not positive.
+*/
+__RTT RangeGenerator<R> GenerateRange(Range<R> r, std::type_identity_t<R> step = 1, RangeCancelToken token = {})
+{
+    if (r.IsEmpty() || !(step > 0)) co_return;
+    R v = r.Begin;
+    while (!token.IsCancelled())
+    {
+        co_yield v;
+        if (RangeStepsLeft(v, r.End, step) == 0) break;
+        v = RangeAdvance(v, 1, step);
+    }
+}
+
+/*
+@brief Generates r as consecutive sub-ranges of up to k items each (the last batch may be shorter).
+Batches include their End, so iterate a batch with GenerateRange(batch, step), not BeginIter/EndIter (which stop before End).
+@param r The range to split.
+@param k Number of items per batch (must be positive).
+@param step The step size (must be positive).
+@param token Cancellation token checked before every yield.
+@return A generator over the batches of r; it yields nothing if r is empty, k is 0 or step is not positive.
+*/
+__RTT RangeGenerator<Range<R>> GenerateBatches(Range<R> r, uint64_t k, std::type_identity_t<R> step = 1, RangeCancelToken token = {})
+{
+    if (r.IsEmpty() || k == 0 || !(step > 0)) co_return;
+    R v = r.Begin;
+    while (!token.IsCancelled())
+    {
+        uint64_t left = RangeStepsLeft(v, r.End, step);
+        uint64_t n = left < k - 1 ? left : k - 1;  // Further items in this batch after v
+        R last = RangeAdvance(v, n, step);
+        co_yield Range<R>(v, last);
+        if (n == left) break;
+        v = RangeAdvance(last, 1, step);
+    }
+}
+
+/*
+@brief Single threaded executor that resumes queued coroutines in FIFO order.
+*/
+class RangeEventLoop
+{
+private:
+    std::deque<std::coroutine_handle<>> ready;  // Coroutines waiting to be resumed
+
+public:
+    /*
+    @brief Queues a coroutine to be resumed by Run.
+    @param h The coroutine to resume.
+    */
+    void Post(std::coroutine_handle<> h) { ready.push_back(h); }
+
+    /*
+    @brief Resumes queued coroutines until none are left.
+    */
+    void Run()
+    {
+        while (!ready.empty())
+        {
+            std::coroutine_handle<> h = ready.front();
+            ready.pop_front();
+            h.resume();
+        }
+    }
+
+    /*
+    @brief Awaitable that requeues the current coroutine so other tasks can run (used for pacing).
+    @return An awaitable.
+    */
+    auto Yield()
+    {
+        struct Awaiter
+        {
+            RangeEventLoop *loop;
+            bool await_ready() { return false; }
+            void await_suspend(std::coroutine_handle<> h) { loop->Post(h); }
+            void await_resume() {}
+        };
+        return Awaiter{this};
+    }
+};
+
+/*
+@brief Coroutine task driven by a RangeEventLoop. The task owns its frame and destroys it when destroyed.
+*/
+class RangeTask
+{
+public:
+    struct promise_type
+    {
+        RangeTask get_return_object() { return RangeTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    explicit RangeTask(std::coroutine_handle<promise_type> h) : handle(h) {}
+    RangeTask(RangeTask &&t) noexcept : handle(t.handle) { t.handle = nullptr; }
+    RangeTask(const RangeTask &) = delete;
+    ~RangeTask() { if (handle) handle.destroy(); }
+
+    /*
+    @brief Schedules the task on an event loop.
+    @param loop The event loop that runs the task.
+    */
+    void Start(RangeEventLoop &loop) { loop.Post(handle); }
+
+    /*
+    @brief Checks if the task has finished.
+    @return True if finished, false otherwise.
+    */
+    bool Done() { return handle.done(); }
+
+private:
+    std::coroutine_handle<promise_type> handle;  // Owned coroutine frame
+};
+
+/*
+@brief Bounded single-producer/single-consumer stream of Range<R> batches.
+The producer suspends in Push while the stream is full and the consumer suspends in Next while it is empty,
+so a fast producer is paced by its consumer without a thread per stream.
+*/
+__RTT
+class RangeStream
+{
+private:
+    RangeEventLoop *loop;                  // Loop that resumes suspended producer/consumer
+    size_t capacity;                       // Maximum number of buffered batches
+    std::deque<Range<R>> buffer;           // Batches pushed but not yet consumed
+    std::coroutine_handle<> producer;      // Producer suspended on a full stream
+    std::coroutine_handle<> consumer;      // Consumer suspended on an empty stream
+    bool closed = false;                   // Set once no more batches will be pushed or accepted
+
+    void Wake(std::coroutine_handle<> &h) { if (h) { loop->Post(h); h = nullptr; } }
+
+public:
+    /*
+    @brief Constructor for the RangeStream class.
+    @param loop The event loop that resumes suspended coroutines.
+    @param capacity Maximum number of buffered batches (must be positive).
+    */
+    RangeStream(RangeEventLoop &loop, size_t capacity) : loop(&loop), capacity(capacity) {}
+
+    /*
+    @brief Awaitable that appends a batch, suspending while the stream is full.
+    @param value The batch to append.
+    @return An awaitable yielding false if the stream was closed and the batch dropped.
+    */
+    auto Push(Range<R> value)
+    {
+        struct Awaiter
+        {
+            RangeStream *s;
+            Range<R> value;
+            bool await_ready() { return s->closed || s->buffer.size() < s->capacity; }
+            void await_suspend(std::coroutine_handle<> h) { s->producer = h; }
+            bool await_resume()
+            {
+                if (s->closed) return false;
+                s->buffer.push_back(value);
+                s->Wake(s->consumer);
+                return true;
+            }
+        };
+        return Awaiter{this, value};
+    }
+
+    /*
+    @brief Awaitable that takes the next batch, suspending while the stream is empty.
+    @return An awaitable yielding the batch, or std::nullopt once the stream is closed and drained.
+    */
+    auto Next()
+    {
+        struct Awaiter
+        {
+            RangeStream *s;
+            bool await_ready() { return s->closed || !s->buffer.empty(); }
+            void await_suspend(std::coroutine_handle<> h) { s->consumer = h; }
+            std::optional<Range<R>> await_resume()
+            {
+                if (s->buffer.empty()) return std::nullopt;
+                Range<R> value = s->buffer.front();
+                s->buffer.pop_front();
+                s->Wake(s->producer);
+                return value;
+            }
+        };
+        return Awaiter{this};
+    }
+
+    /*
+    @brief Closes the stream and wakes any suspended producer or consumer.
+    Buffered batches can still be taken with Next.
+    */
+    void Close() { closed = true; Wake(producer); Wake(consumer); }
+
+    /*
+    @brief Returns the number of buffered batches.
+    @return The number of buffered batches.
+    */
+    size_t Size() { return buffer.size(); }
+
+    /*
+    @brief Checks if the stream has been closed.
+    @return True if closed, false otherwise.
+    */
+    bool IsClosed() { return closed; }
+};
+
+/*
+@brief Producer task that pushes r into a stream in batches of k items, then closes the stream.
+@param stream The stream to feed.
+@param r The range to produce.
+@param k Number of items per batch (must be positive).
+@param step The step size (must be positive).
+@param token Cancellation token; a cancelled producer closes the stream early.
+Invalid k or step produce no batches, so the stream is closed straight away.
+@return The producer task (start it with RangeTask::Start).
+*/
+__RTT RangeTask ProduceRange(RangeStream<R> &stream, Range<R> r, uint64_t k, std::type_identity_t<R> step = 1, RangeCancelToken token = {})
+{
+    for (Range<R> batch : GenerateBatches(r, k, step, token))
+    {
+        if (!co_await stream.Push(batch)) break;
+    }
+    stream.Close();
+}
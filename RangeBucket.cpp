@@ -0,0 +1,376 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "Range.cpp"
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/*
+Bucketing of values by a sorted list of Range<R> boundaries, for histograms and partitioned sort.
+Threaded helpers need -pthread on older toolchains.
+*/
+
+/*
+@brief Values grouped by bucket: bucket i occupies Values[Offsets[i]] .. Values[Offsets[i + 1] - 1].
+*/
+__RTT
+struct RangePartition
+{
+    std::vector<R> Values;        // Values stored bucket after bucket
+    std::vector<size_t> Offsets;  // Start of every bucket in Values, plus the total size at the back
+
+    /*
+    @brief Returns a pointer to the first value of bucket i.
+    @param i The bucket index.
+    @return A pointer to the values of the bucket.
+    */
+    const R *BucketData(size_t i) const { return Values.data() + Offsets[i]; }
+
+    /*
+    @brief Returns the number of values in bucket i.
+    @param i The bucket index.
+    @return The size of the bucket.
+    */
+    size_t BucketSize(size_t i) const { return Offsets[i + 1] - Offsets[i]; }
+};
+
+__RTT
+class RangeBuckets
+{
+private:
+    std::vector<R> begins, ends;  // Boundaries split into separate arrays so the search touches only begins
+
+    /*
+    @brief Runs fn(t, first, last) on `threads` threads over consecutive chunks of [0, n).
+    */
+    template<typename F>
+    static void ParallelChunks(size_t n, unsigned threads, F fn)
+    {
+        std::vector<std::thread> pool;
+        for (unsigned t = 0; t < threads; t++)
+        {
+            size_t first = n * t / threads, last = n * (t + 1) / threads;
+            pool.emplace_back(fn, t, first, last);
+        }
+        for (std::thread &th : pool) th.join();
+    }
+
+    /*
+    @brief Clamps a thread count to [1, n] and replaces 0 with the hardware concurrency.
+    */
+    static unsigned ThreadCount(unsigned threads, size_t n)
+    {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        return (unsigned)std::max<size_t>(1, std::min<size_t>(threads, n));
+    }
+
+public:
+    /*
+    @brief Constructor for the RangeBuckets class. Bucket i is boundaries[i].
+    @param boundaries The ranges that define the buckets, sorted by Begin.
+    @throws std::invalid_argument if a range is empty or has Begin > End, or the ranges are unsorted or overlap.
+    */
+    RangeBuckets(const std::vector<Range<R>> &boundaries)
+    {
+        for (size_t i = 0; i < boundaries.size(); i++)
+        {
+            Range<R> r = boundaries[i];
+            if (r.IsEmpty() || r.Begin > r.End) throw std::invalid_argument("RangeBuckets: empty range");
+            if (i > 0 && r.Begin <= ends.back()) throw std::invalid_argument("RangeBuckets: unsorted or overlapping ranges");
+            begins.push_back(r.Begin);
+            ends.push_back(r.End);
+        }
+    }
+
+    /*
+    @brief Returns the range of bucket i.
+    @param i The bucket index (less than Count()).
+    @return The boundary range of the bucket.
+    */
+    Range<R> Boundary(size_t i) const { return Range<R>(begins[i], ends[i]); }
+
+    /*
+    @brief Returns the number of boundary ranges. Index Count() is the bucket for values outside every range.
+    @return The number of boundary ranges.
+    */
+    size_t Count() const { return begins.size(); }
+
+    /*
+    @brief Returns the bucket of v without data dependent branches.
+    @param v The value to classify.
+    @return The index of the range containing v, or Count() if no range contains it.
+    */
+    size_t Classify(R v) const
+    {
+        if (begins.empty()) return 0;
+        const R *base = begins.data();
+        size_t n = begins.size();
+        while (n > 1)  // Trip count depends only on Count(), so the loop body becomes conditional moves
+        {
+            size_t half = n / 2;
+            base = (base[half] <= v) ? base + half : base;
+            n -= half;
+        }
+        size_t i = base - begins.data();
+        bool inside = (begins[i] <= v) & (v <= ends[i]);
+        return inside ? i : begins.size();
+    }
+
+    /*
+    @brief Classifies n values into out. With AVX2, 32-bit integers are searched eight per vector
+    using gathers. Otherwise a scalar search runs 16 values in lockstep, so the independent
+    searches overlap their memory latency.
+    @param values The values to classify.
+    @param n The number of values.
+    @param out Receives the bucket of every value.
+    */
+    void ClassifyBatch(const R *values, size_t n, uint32_t *out) const
+    {
+        constexpr size_t Group = 16;
+        size_t count = begins.size();
+        if (count == 0) { std::fill(out, out + n, 0); return; }
+        const R *b = begins.data(), *e = ends.data();
+
+        size_t i = 0;
+#if defined(__AVX2__)
+        if constexpr (std::is_integral_v<R> && sizeof(R) == 4) i = ClassifyBatchAvx2(values, n, out);
+#endif
+        for (; i + Group <= n; i += Group)
+        {
+            size_t idx[Group] = {};
+            for (size_t len = count; len > 1; len -= len / 2)
+            {
+                size_t half = len / 2;
+                for (size_t j = 0; j < Group; j++) idx[j] += (b[idx[j] + half] <= values[i + j]) ? half : 0;
+            }
+            for (size_t j = 0; j < Group; j++)
+            {
+                bool inside = (b[idx[j]] <= values[i + j]) & (values[i + j] <= e[idx[j]]);
+                out[i + j] = (uint32_t)(inside ? idx[j] : count);
+            }
+        }
+        for (; i < n; i++) out[i] = (uint32_t)Classify(values[i]);
+    }
+
+    /*
+    @brief Counts how many values fall in every bucket using per-thread histograms merged at the end.
+    @param values The values to count.
+    @param n The number of values.
+    @param threads Number of threads (0 uses the hardware concurrency).
+    @return Count() + 1 counters; the last one counts values outside every range.
+    */
+    std::vector<uint64_t> Histogram(const R *values, size_t n, unsigned threads = 0) const
+    {
+        threads = ThreadCount(threads, n);
+        size_t buckets = Count() + 1;
+        std::vector<std::vector<uint64_t>> local(threads, std::vector<uint64_t>(buckets, 0));
+        ParallelChunks(n, threads, [&](unsigned t, size_t first, size_t last) {
+            uint32_t ids[1024];
+            std::vector<uint64_t> &h = local[t];
+            for (size_t i = first; i < last; i += 1024)
+            {
+                size_t len = std::min<size_t>(1024, last - i);
+                ClassifyBatch(values + i, len, ids);
+                for (size_t j = 0; j < len; j++) h[ids[j]]++;
+            }
+        });
+
+        std::vector<uint64_t> total(buckets, 0);
+        for (std::vector<uint64_t> &h : local)
+            for (size_t i = 0; i < buckets; i++) total[i] += h[i];
+        return total;
+    }
+
+    /*
+    @brief Partitions values into per-range buffers in parallel. Every thread counts its chunk,
+    the counts are turned into disjoint write offsets, and every thread classifies its chunk again
+    block by block while scattering, so no per-value bucket array is kept.
+    Values keep their input order inside a bucket.
+    @param values The values to partition.
+    @param n The number of values.
+    @param out Receives the n values grouped by bucket.
+    @param offsets Receives Count() + 2 entries: the start of every bucket plus n at the back.
+    @param threads Number of threads (0 uses the hardware concurrency).
+    */
+    void PartitionInto(const R *values, size_t n, R *out, size_t *offsets, unsigned threads = 0) const
+    {
+        constexpr size_t Block = 1024;
+        threads = ThreadCount(threads, n);
+        size_t buckets = Count() + 1;
+        std::vector<std::vector<size_t>> local(threads, std::vector<size_t>(buckets, 0));
+        ParallelChunks(n, threads, [&](unsigned t, size_t first, size_t last) {
+            uint32_t ids[Block];
+            for (size_t i = first; i < last; i += Block)
+            {
+                size_t len = std::min<size_t>(Block, last - i);
+                ClassifyBatch(values + i, len, ids);
+                for (size_t j = 0; j < len; j++) local[t][ids[j]]++;
+            }
+        });
+
+        // Bucket-major, thread-minor prefix sum: thread t writes bucket b at local[t][b]
+        size_t offset = 0;
+        for (size_t b = 0; b < buckets; b++)
+        {
+            offsets[b] = offset;
+            for (unsigned t = 0; t < threads; t++)
+            {
+                size_t c = local[t][b];
+                local[t][b] = offset;
+                offset += c;
+            }
+        }
+        offsets[buckets] = offset;
+
+        ParallelChunks(n, threads, [&](unsigned t, size_t first, size_t last) {
+            uint32_t ids[Block];
+            std::vector<size_t> &pos = local[t];
+            for (size_t i = first; i < last; i += Block)
+            {
+                size_t len = std::min<size_t>(Block, last - i);
+                ClassifyBatch(values + i, len, ids);
+                for (size_t j = 0; j < len; j++) out[pos[ids[j]]++] = values[i + j];
+            }
+        });
+    }
+
+    /*
+    @brief Partitions values into per-range buffers in parallel (see PartitionInto).
+    @param values The values to partition.
+    @param n The number of values.
+    @param threads Number of threads (0 uses the hardware concurrency).
+    @return The values grouped by bucket; bucket Count() holds values outside every range.
+    */
+    RangePartition<R> Partition(const R *values, size_t n, unsigned threads = 0) const
+    {
+        RangePartition<R> result;
+        result.Values.resize(n);
+        result.Offsets.assign(Count() + 2, 0);
+        PartitionInto(values, n, result.Values.data(), result.Offsets.data(), threads);
+        return result;
+    }
+
+    /*
+    @brief Partitions values by range and sorts every bucket in parallel. Since the ranges are sorted
+    and disjoint, buckets 0 .. Count() - 1 read in order form a sorted sequence.
+    Buckets larger than n / threads are split again by splitters sampled from their own values,
+    so a dominant bucket is sorted by all threads instead of one.
+    @param values The values to sort.
+    @param n The number of values.
+    @param threads Number of threads (0 uses the hardware concurrency).
+    @return The values grouped by bucket with every bucket sorted.
+    */
+    RangePartition<R> PartitionSort(const R *values, size_t n, unsigned threads = 0) const
+    {
+        threads = ThreadCount(threads, n);
+        RangePartition<R> result = Partition(values, n, threads);
+
+        std::vector<SortTask> tasks;
+        std::vector<std::vector<R>> scratch;  // Sub-partitioned copies of the large buckets
+        size_t large = std::max<size_t>(n / threads, 1 << 16);
+        for (size_t b = 0; b < Count() + 1; b++)
+        {
+            R *data = result.Values.data() + result.Offsets[b];
+            size_t size = result.BucketSize(b);
+            if (threads > 1 && size > large) SplitForSort(data, size, threads, tasks, scratch);
+            else tasks.push_back(SortTask{data, size, data});
+        }
+
+        // Largest tasks first so the dynamic hand out ends with small ones
+        std::sort(tasks.begin(), tasks.end(), [](const SortTask &a, const SortTask &b) { return a.Size > b.Size; });
+        std::atomic<size_t> next(0);
+        ParallelChunks(threads, threads, [&](unsigned, size_t, size_t) {
+            for (size_t i = next++; i < tasks.size(); i = next++)
+            {
+                SortTask &task = tasks[i];
+                std::sort(task.Data, task.Data + task.Size);
+                if (task.Dest != task.Data) std::copy(task.Data, task.Data + task.Size, task.Dest);
+            }
+        });
+        return result;
+    }
+
+private:
+#if defined(__AVX2__)
+    /*
+    @brief AVX2 search for 32-bit integers: the branch-free search of Classify on eight lanes, with the
+    probes loaded by gathers. Unsigned values are compared with the sign bit flipped.
+    @return The number of values classified (a multiple of 8; the caller handles the rest).
+    */
+    size_t ClassifyBatchAvx2(const R *values, size_t n, uint32_t *out) const
+    {
+        size_t count = begins.size();
+        if (count > (size_t)INT32_MAX) return 0;
+        const int *b = (const int *)begins.data(), *e = (const int *)ends.data();
+        const __m256i flip = _mm256_set1_epi32(std::is_signed_v<R> ? 0 : INT32_MIN);
+        const __m256i outside = _mm256_set1_epi32((int)count);
+
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            __m256i v = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(values + i)), flip);
+            __m256i idx = _mm256_setzero_si256();
+            for (size_t len = count; len > 1; len -= len / 2)
+            {
+                __m256i half = _mm256_set1_epi32((int)(len / 2));
+                __m256i probe = _mm256_xor_si256(_mm256_i32gather_epi32(b, _mm256_add_epi32(idx, half), 4), flip);
+                idx = _mm256_add_epi32(idx, _mm256_andnot_si256(_mm256_cmpgt_epi32(probe, v), half));  // Step when probe <= v
+            }
+            __m256i lo = _mm256_xor_si256(_mm256_i32gather_epi32(b, idx, 4), flip);
+            __m256i hi = _mm256_xor_si256(_mm256_i32gather_epi32(e, idx, 4), flip);
+            __m256i miss = _mm256_or_si256(_mm256_cmpgt_epi32(lo, v), _mm256_cmpgt_epi32(v, hi));
+            _mm256_storeu_si256((__m256i *)(out + i), _mm256_blendv_epi8(idx, outside, miss));
+        }
+        return i;
+    }
+#endif
+
+    /*
+    @brief A slice to sort, copied to Dest afterwards when it was sorted in a scratch buffer.
+    */
+    struct SortTask
+    {
+        R *Data;     // Values to sort
+        size_t Size; // Number of values
+        R *Dest;     // Where the sorted values belong
+    };
+
+    /*
+    @brief Splits one large bucket into sub-buckets by splitters sampled from its values and queues them.
+    The sub-buckets cover every value of R, so the bucket is partitioned (in parallel) into scratch
+    and every sub-bucket becomes an independent sort task that copies back into place.
+    */
+    static void SplitForSort(R *data, size_t size, unsigned threads, std::vector<SortTask> &tasks, std::vector<std::vector<R>> &scratch)
+    {
+        size_t parts = (size_t)threads * 4, samples = parts * 16;
+        std::vector<R> sample;
+        for (size_t i = 0; i < samples; i++) sample.push_back(data[i * size / samples]);
+        std::sort(sample.begin(), sample.end());
+
+        R lo = std::numeric_limits<R>::has_infinity ? -std::numeric_limits<R>::infinity() : std::numeric_limits<R>::lowest();
+        R hi = std::numeric_limits<R>::has_infinity ? std::numeric_limits<R>::infinity() : std::numeric_limits<R>::max();
+        std::vector<Range<R>> boundaries;
+        for (size_t j = 1; j < parts; j++)
+        {
+            R splitter = sample[j * samples / parts];
+            if (splitter < lo || splitter >= hi) continue;  // Duplicate splitter, or one with no successor
+            boundaries.push_back(Range<R>(lo, splitter));
+            lo = Range<R>::Successor(splitter);
+        }
+        boundaries.push_back(Range<R>(lo, hi));
+
+        RangeBuckets<R> sub(boundaries);
+        scratch.emplace_back(size);
+        R *tmp = scratch.back().data();
+        std::vector<size_t> offsets(sub.Count() + 2);
+        sub.PartitionInto(data, size, tmp, offsets.data(), threads);
+        for (size_t k = 0; k < sub.Count() + 1; k++)
+            tasks.push_back(SortTask{tmp + offsets[k], offsets[k + 1] - offsets[k], data + offsets[k]});
+    }
+};
@@ -0,0 +1,232 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "Range.cpp"
+
+/*
+Compact binary encoding for sorted lists of integer Range<R>.
+Every range is written as two LEB128 varints: the zigzag encoded gap from the previous End
+(the first range is measured from 0), then the length End - Begin.
+Sorted lists with small gaps and lengths take two bytes per range.
+Empty ranges carry no values and are skipped by the encoder.
+*/
+
+/*
+@brief Returns the largest number of bytes one varint of type R can take.
+@return The maximum varint size of R.
+*/
+__RTT constexpr size_t RangeVarintMax() { return (sizeof(R) * 8 + 6) / 7; }
+
+/*
+@brief Returns an upper bound on the encoded size of count ranges, for sizing caller buffers.
+@param count The number of ranges.
+@return The maximum number of bytes RangeEncode can write.
+*/
+__RTT constexpr size_t RangeEncodedBound(size_t count) { return count * 2 * RangeVarintMax<R>(); }
+
+/*
+@brief Incremental encoder that writes ranges into a caller supplied buffer without copies.
+*/
+__RTT
+class RangeEncoder
+{
+    static_assert(std::is_integral_v<R>, "RangeEncoder needs an integer range type");
+    using U = std::make_unsigned_t<R>;
+
+private:
+    uint8_t *out, *limit;  // Next byte to write and the end of the caller buffer
+    uint8_t *start;        // Beginning of the caller buffer
+    U prev = 0;            // End of the previously written range
+
+    static uint8_t *PutVarint(uint8_t *p, U v)
+    {
+        while (v >= 0x80) { *p++ = (uint8_t)(v | 0x80); v >>= 7; }
+        *p++ = (uint8_t)v;
+        return p;
+    }
+
+    U Gap(Range<R> r) const
+    {
+        // Zigzag encoded gap between the previous End and r.Begin, so small backwards steps stay short
+        U d = (U)((U)r.Begin - prev);
+        return (U)((U)(d << 1) ^ (U)(-(U)(d >> (sizeof(U) * 8 - 1))));
+    }
+
+public:
+    /*
+    @brief Constructor for the RangeEncoder class.
+    @param buffer The buffer to write into.
+    @param capacity The size of the buffer in bytes.
+    */
+    RangeEncoder(uint8_t *buffer, size_t capacity) : out(buffer), limit(buffer + capacity), start(buffer) {}
+
+    /*
+    @brief Appends a range.
+    @param r The range to append (should not begin before the previous End for a compact result).
+    @return False if the buffer is too small (nothing is written), true otherwise.
+    */
+    bool Put(Range<R> r)
+    {
+        if (r.IsEmpty()) return true;
+        if ((size_t)(limit - out) < 2 * RangeVarintMax<R>())
+        {
+            // Near the end of the buffer: measure exactly before writing
+            uint8_t tmp[2 * RangeVarintMax<R>()];
+            size_t len = PutVarint(PutVarint(tmp, Gap(r)), (U)((U)r.End - (U)r.Begin)) - tmp;
+            if ((size_t)(limit - out) < len) return false;
+        }
+        out = PutVarint(out, Gap(r));
+        out = PutVarint(out, (U)((U)r.End - (U)r.Begin));
+        prev = (U)r.End;
+        return true;
+    }
+
+    /*
+    @brief Returns the number of bytes written so far.
+    @return The encoded size.
+    */
+    size_t Size() const { return out - start; }
+};
+
+/*
+@brief Encodes count ranges into a caller supplied buffer.
+@param ranges The ranges, sorted by Begin.
+@param count The number of ranges.
+@param out The buffer to write into (RangeEncodedBound<R>(count) bytes always suffice).
+@param capacity The size of the buffer in bytes.
+@return The number of bytes written, or 0 if the buffer is too small.
+*/
+__RTT size_t RangeEncode(const Range<R> *ranges, size_t count, uint8_t *out, size_t capacity)
+{
+    RangeEncoder<R> encoder(out, capacity);
+    for (size_t i = 0; i < count; i++)
+        if (!encoder.Put(ranges[i])) return 0;
+    return encoder.Size();
+}
+
+/*
+@brief Streaming decoder that reads ranges one at a time (or in batches) straight from the encoded buffer.
+Data may arrive in chunks: when a chunk ends inside a range the decoder stops before that range and
+reports IsIncomplete(). The caller then passes the unconsumed tail (from Consumed() on) followed by
+the next chunk to Feed, and decoding resumes where it stopped.
+*/
+__RTT
+class RangeDecoder
+{
+    static_assert(std::is_integral_v<R>, "RangeDecoder needs an integer range type");
+    using U = std::make_unsigned_t<R>;
+
+private:
+    const uint8_t *in, *limit;  // Next byte to read and the end of the encoded data
+    const uint8_t *start;       // Beginning of the current buffer
+    U prev = 0;                 // End of the previously decoded range
+    bool error = false;         // Set when a varint is too long or does not fit in U
+    bool incomplete = false;    // Set when the buffer ends inside a range
+
+    bool GetVarint(U &v)
+    {
+        v = 0;
+        for (size_t shift = 0; shift < sizeof(U) * 8; shift += 7)
+        {
+            if (in == limit) { incomplete = true; return false; }
+            uint8_t byte = *in++;
+            size_t room = sizeof(U) * 8 - shift;  // Payload bits of U still free at this byte
+            if (room < 7 && ((byte & 0x7f) >> room)) { error = true; return false; }  // Bits past the width of U
+            v |= (U)((U)(byte & 0x7f) << shift);
+            if (!(byte & 0x80)) return true;
+        }
+        error = true;
+        return false;
+    }
+
+    Range<R> Make(U gap, U length)
+    {
+        U begin = (U)(prev + (U)((gap >> 1) ^ (U)(-(U)(gap & 1))));
+        prev = (U)(begin + length);
+        return Range<R>((R)begin, (R)prev);
+    }
+
+public:
+    /*
+    @brief Constructor for the RangeDecoder class.
+    @param data The encoded bytes.
+    @param size The number of encoded bytes.
+    */
+    RangeDecoder(const uint8_t *data, size_t size) : in(data), limit(data + size), start(data) {}
+
+    /*
+    @brief Continues decoding from a new buffer, keeping the position in the range list.
+    @param data The unconsumed tail of the previous buffer followed by newly arrived bytes.
+    @param size The number of bytes.
+    */
+    void Feed(const uint8_t *data, size_t size) { in = start = data; limit = data + size; incomplete = false; }
+
+    /*
+    @brief Decodes the next range. On a partial range nothing is consumed (see IsIncomplete).
+    @param r Receives the decoded range.
+    @return False at the end of the data, on a partial range or on malformed data (see IsError), true otherwise.
+    */
+    bool Next(Range<R> &r)
+    {
+        if (in == limit || error || incomplete) return false;
+        const uint8_t *mark = in;
+        U gap, length;
+        if (!GetVarint(gap) || !GetVarint(length))
+        {
+            if (incomplete) in = mark;  // Leave the partial range for the next Feed
+            return false;
+        }
+        r = Make(gap, length);
+        return true;
+    }
+
+    /*
+    @brief Decodes up to max ranges. Runs of single byte varints are detected eight bytes at a time
+    (a word load and one mask test) and decoded without per-byte branches.
+    @param out Receives the decoded ranges.
+    @param max The capacity of out.
+    @return The number of ranges decoded; fewer than max only at the end of the data, on a partial range or on an error.
+    */
+    size_t NextBatch(Range<R> *out, size_t max)
+    {
+        size_t n = 0;
+        while (n < max)
+        {
+            if (n + 4 <= max && limit - in >= 8 && !error && !incomplete)
+            {
+                uint64_t word;
+                std::memcpy(&word, in, 8);
+                if (!(word & 0x8080808080808080ull))  // Four ranges of single byte varints
+                {
+                    for (size_t j = 0; j < 4; j++) out[n + j] = Make(in[2 * j], in[2 * j + 1]);
+                    in += 8;
+                    n += 4;
+                    continue;
+                }
+            }
+            if (!Next(out[n])) break;
+            n++;
+        }
+        return n;
+    }
+
+    /*
+    @brief Returns how many bytes of the current buffer have been decoded; a partial range is not counted.
+    @return The number of consumed bytes.
+    */
+    size_t Consumed() const { return in - start; }
+
+    /*
+    @brief Checks if the decoder stopped because the buffer ends inside a range (more data is needed).
+    At the end of a stream this means the data was truncated.
+    @return True if more data is needed, false otherwise.
+    */
+    bool IsIncomplete() const { return incomplete; }
+
+    /*
+    @brief Checks if the decoder stopped on malformed data (a varint too long or too wide for R).
+    @return True if an error occurred, false otherwise.
+    */
+    bool IsError() const { return error; }
+};
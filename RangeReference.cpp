@@ -0,0 +1,90 @@
+#pragma once
+#include <limits>
+#include <type_traits>
+#include <vector>
+#include "Range.cpp"
+
+/*
+Reference model for the Range set operations.
+The model never reuses the bound arithmetic of Range.cpp: it treats every range as the set of values
+it holds and compares results value by value. For int8_t/uint8_t every value of the type is checked.
+For wider types the checked values are every bound of the operands and results plus its neighbours,
+which is enough because set membership can only change at a bound.
+*/
+namespace RangeReference
+{
+    /*
+    @brief Checks whether the closed range r holds x.
+    @param r The range.
+    @param x The value.
+    @return True if x belongs to r, false otherwise.
+    */
+    __RTT bool Has(Range<R> r, R x)
+    {
+        return !r.IsEmpty() && r.Begin <= x && x <= r.End;
+    }
+
+    /*
+    @brief Returns the values the model checks for a set of ranges.
+    @param ranges The operands and results of an operation.
+    @return Every value of R for 8-bit types, otherwise every bound of the ranges and its neighbours.
+    */
+    __RTT std::vector<R> Probes(std::vector<Range<R>> ranges)
+    {
+        using U = std::make_unsigned_t<R>;
+        std::vector<R> probes;
+        if constexpr (sizeof(R) == 1)
+        {
+            for (int x = 0; x < 256; x++) probes.push_back((R)(U)x);
+            return probes;
+        }
+        probes.push_back(std::numeric_limits<R>::min());
+        probes.push_back(std::numeric_limits<R>::max());
+        for (Range<R> r : ranges)
+        {
+            for (R bound : {r.Begin, r.End})
+            {
+                probes.push_back((R)((U)bound - 1));  // Neighbours wrap; an extra probe is harmless
+                probes.push_back(bound);
+                probes.push_back((R)((U)bound + 1));
+            }
+        }
+        return probes;
+    }
+
+    /*
+    @brief Checks Intersection, Union and Difference of a and b against set membership.
+    Intersection holds the values in both ranges. Union holds the values in either range when the ranges
+    share a value (or one is empty) and is empty otherwise. The two pieces of Difference(b, upper) together
+    hold exactly the values of a that are not in b, with the returned piece below upper.
+    @param a The first range.
+    @param b The second range.
+    @return True if every operation agrees with the model, false otherwise.
+    */
+    __RTT bool Check(Range<R> a, Range<R> b)
+    {
+        Range<R> upper = Range<R>::EmptyRange();
+        Range<R> i = a.Intersection(b), u = a.Union(b), d = a.Difference(b, upper);
+        std::vector<R> probes = Probes<R>({a, b, i, u, d, upper});
+
+        bool shared = false;
+        for (R x : probes) shared = shared || (Has(a, x) && Has(b, x));
+        bool unionExists = shared || a.IsEmpty() || b.IsEmpty();
+
+        for (R x : probes)
+        {
+            if (Has(i, x) != (Has(a, x) && Has(b, x))) return false;
+            if (Has(u, x) != (unionExists && (Has(a, x) || Has(b, x)))) return false;
+            if ((Has(d, x) || Has(upper, x)) != (Has(a, x) && !Has(b, x))) return false;
+            if (Has(d, x) && Has(upper, x)) return false;  // The pieces do not overlap
+        }
+        if (!upper.IsEmpty() && (d.IsEmpty() || d.End >= upper.Begin)) return false;
+
+        // (a - b) & b is empty, the one-piece forms match the returned piece, and the operations are symmetric where they should be
+        if (!d.Intersection(b).IsEmpty() || !upper.Intersection(b).IsEmpty()) return false;
+        if (a.Difference(b) != d || (a - b) != d) return false;
+        if (i != b.Intersection(a) || u != b.Union(a)) return false;
+        if (!a.IsContain(i) || !b.IsContain(i)) return false;
+        return true;
+    }
+}
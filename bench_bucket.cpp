@@ -0,0 +1,74 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+#include "RangeBucket.cpp"
+
+/*
+Benchmark of RangeBuckets Histogram and PartitionSort across thread counts, against a per-range IsContain scan.
+Build: g++ -std=c++20 -O2 -pthread -o bench_bucket bench_bucket.cpp
+Usage: ./bench_bucket [values] [max threads]
+Values follow a skewed latency-like distribution so one bucket holds most of them.
+*/
+
+double Seconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    unsigned maxThreads = argc > 2 ? (unsigned)std::atoi(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+
+    // 64 latency buckets growing geometrically, with gaps between some of them
+    std::vector<Range<uint32_t>> boundaries;
+    uint32_t lo = 0;
+    for (int i = 0; i < 64; i++)
+    {
+        uint32_t width = 16u << (i / 4);
+        boundaries.push_back(Range<uint32_t>(lo, lo + width - 1));
+        lo += width + (i % 3 == 0 ? width / 2 : 0);
+    }
+    RangeBuckets<uint32_t> buckets(boundaries);
+
+    std::mt19937_64 rng(2077);
+    std::lognormal_distribution<double> latency(6.0, 1.5);
+    std::vector<uint32_t> values(count);
+    for (uint32_t &v : values) v = (uint32_t)std::min(latency(rng), 4e9);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<uint64_t> naive(boundaries.size() + 1, 0);
+    for (uint32_t v : values)
+    {
+        size_t b = 0;
+        while (b < boundaries.size() && !boundaries[b].IsContain(Range<uint32_t>(v, v))) b++;
+        naive[b]++;
+    }
+    double naiveTime = Seconds(start);
+
+    std::printf("%zu values, %zu ranges, hardware threads %u\n", count, boundaries.size(), std::thread::hardware_concurrency());
+    std::printf("IsContain scan histogram: %.3f s (%.1f M values/s)\n", naiveTime, count / naiveTime / 1e6);
+    std::printf("%8s %14s %10s %16s %10s\n", "threads", "histogram s", "speedup", "partition sort s", "speedup");
+    double histogramBase = 0, sortBase = 0;
+    std::vector<unsigned> threadCounts;
+    for (unsigned t = 1; t < maxThreads; t *= 2) threadCounts.push_back(t);
+    threadCounts.push_back(maxThreads);  // Always finish with every thread
+    for (unsigned t : threadCounts)
+    {
+        start = std::chrono::steady_clock::now();
+        std::vector<uint64_t> histogram = buckets.Histogram(values.data(), count, t);
+        double histogramTime = Seconds(start);
+        if (histogram != naive) { std::printf("histogram mismatch\n"); return 1; }
+
+        start = std::chrono::steady_clock::now();
+        RangePartition<uint32_t> sorted = buckets.PartitionSort(values.data(), count, t);
+        double sortTime = Seconds(start);
+
+        if (t == 1) { histogramBase = histogramTime; sortBase = sortTime; }
+        std::printf("%8u %14.3f %10.2f %16.3f %10.2f\n", t, histogramTime, histogramBase / histogramTime, sortTime, sortBase / sortTime);
+    }
+    return 0;
+}
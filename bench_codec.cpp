@@ -0,0 +1,74 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+#include <vector>
+#include "RangeCodec.cpp"
+
+/*
+Benchmark of RangeCodec against the operator<< text format on a NACK-like sorted range list.
+Build: g++ -std=c++20 -O2 -o bench_codec bench_codec.cpp
+Throughput is reported in GB/s of decoded Range payload (two R values per range) so both formats compare directly.
+*/
+
+double Seconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    std::mt19937_64 rng(2077);
+    std::vector<Range<uint64_t>> ranges;
+    uint64_t seq = 1;
+    for (size_t i = 0; i < count; i++)
+    {
+        seq += 1 + rng() % 100;
+        uint64_t len = rng() % 16;
+        ranges.push_back(Range<uint64_t>(seq, seq + len));
+        seq += len;
+    }
+    double payload = (double)count * 2 * sizeof(uint64_t) / 1e9;
+
+    // Binary format
+    std::vector<uint8_t> buffer(RangeEncodedBound<uint64_t>(count));
+    auto start = std::chrono::steady_clock::now();
+    size_t size = RangeEncode(ranges.data(), count, buffer.data(), buffer.size());
+    double encodeTime = Seconds(start);
+
+    std::vector<Range<uint64_t>> decoded(count, Range<uint64_t>(0, 0));
+    start = std::chrono::steady_clock::now();
+    RangeDecoder<uint64_t> decoder(buffer.data(), size);
+    size_t got = 0;
+    for (size_t n; (n = decoder.NextBatch(decoded.data() + got, 1024)) > 0; ) got += n;
+    double decodeTime = Seconds(start);
+    if (got != count || decoded.back() != ranges.back()) { std::printf("binary round trip failed\n"); return 1; }
+
+    // Text format
+    start = std::chrono::steady_clock::now();
+    std::ostringstream os;
+    for (size_t i = 0; i < count; i++) os << ranges[i] << '\n';
+    std::string text = os.str();
+    double textEncodeTime = Seconds(start);
+
+    start = std::chrono::steady_clock::now();
+    const char *p = text.c_str();
+    got = 0;
+    for (char *endp; (p = std::strchr(p, '(')) != nullptr; got++)
+    {
+        uint64_t b = std::strtoull(p + 1, &endp, 10);
+        uint64_t e = std::strtoull(endp + 1, &endp, 10);
+        decoded[got] = Range<uint64_t>(b, e);
+        p = endp;
+    }
+    double textDecodeTime = Seconds(start);
+    if (got != count || decoded.back() != ranges.back()) { std::printf("text round trip failed\n"); return 1; }
+
+    std::printf("%zu ranges\n", count);
+    std::printf("%-8s %12s %14s %14s\n", "format", "bytes/range", "encode GB/s", "decode GB/s");
+    std::printf("%-8s %12.2f %14.3f %14.3f\n", "varint", (double)size / count, payload / encodeTime, payload / decodeTime);
+    std::printf("%-8s %12.2f %14.3f %14.3f\n", "text", (double)text.size() / count, payload / textEncodeTime, payload / textDecodeTime);
+    return 0;
+}
@@ -1,11 +1,99 @@
 #include <iostream>
 #include <string>
+#include <cstdint>
+#include <limits>
+#include <random>
 #include "Range.cpp" // Assuming your class is defined in a header file named Range.hpp
+#include "RangeReference.cpp"
+#include "RangeAsync.cpp"
+#include "RangeBucket.cpp"
+#include "RangeCodec.cpp"
 
 void TestPassed(int num, std::string title){
     std::cout << "\n" << "[Test " << num << "](" << title << ")" << ": " << "✅ Passed" << '\n';
 }
 
+void TestFailed(int num, std::string title){
+    std::cout << "\n" << "[Test " << num << "](" << title << ")" << ": " << "❌ Failed" << '\n';
+    std::exit(1);
+}
+
+/*
+@brief Randomized property test of Intersection/Union/Difference against RangeReference for one type.
+Values are drawn near zero and near both ends of the type so overflow-prone edges are covered.
+@param rng The random generator.
+@param runs Number of random range pairs to check.
+@return True if every pair agrees with the reference model, false otherwise.
+*/
+template<typename R> bool RangePropertyCheck(std::mt19937_64 &rng, int runs){
+    auto pick = [&rng]() -> R {
+        R lo = std::numeric_limits<R>::min(), hi = std::numeric_limits<R>::max();
+        switch (rng() % 3) {
+            case 0: return (R)(rng() % 8);
+            case 1: return (R)(lo + (R)(rng() % 4));
+            default: return (R)(hi - (R)(rng() % 4));
+        }
+    };
+    for (int i = 0; i < runs; i++) {
+        R v[4] = {pick(), pick(), pick(), pick()};
+        Range<R> a(std::min(v[0], v[1]), std::max(v[0], v[1]));
+        Range<R> b(std::min(v[2], v[3]), std::max(v[2], v[3]));
+        a.Empty = rng() % 8 == 0;
+        b.Empty = rng() % 8 == 0;
+        if (!RangeReference::Check(a, b)) {
+            std::cout << "Mismatch for " << a << " and " << b << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+@brief Encodes ranges, decodes them one at a time and in batches, and checks both match the input.
+@param ranges The sorted ranges to round-trip.
+@return True if both decodings reproduce the input exactly, false otherwise.
+*/
+template<typename R> bool RangeCodecRoundTrip(const std::vector<Range<R>> &ranges){
+    std::vector<uint8_t> buffer(RangeEncodedBound<R>(ranges.size()));
+    size_t size = RangeEncode(ranges.data(), ranges.size(), buffer.data(), buffer.size());
+    if (size == 0 && !ranges.empty()) return false;
+
+    RangeDecoder<R> decoder(buffer.data(), size);
+    Range<R> r(0, 0);
+    size_t count = 0;
+    while (decoder.Next(r)) if (count >= ranges.size() || r != ranges[count++]) return false;
+    if (decoder.IsError() || count != ranges.size()) return false;
+
+    std::vector<Range<R>> batch(ranges.size() + 1, Range<R>(0, 0));
+    RangeDecoder<R> batchDecoder(buffer.data(), size);
+    count = 0;
+    for (size_t n; (n = batchDecoder.NextBatch(batch.data() + count, 7)) > 0; ) count += n;
+    if (batchDecoder.IsError() || count != ranges.size()) return false;
+    for (size_t i = 0; i < count; i++) if (batch[i] != ranges[i]) return false;
+    return true;
+}
+
+/*
+@brief Consumer task that sums every value of the batches it takes from a stream.
+@param stream The stream to drain.
+@param step The step size used to iterate each batch.
+@param sum Receives the sum of the values.
+@param maxBuffered Receives the largest number of batches seen buffered.
+@param stopAfter Number of batches to take before cancelling the producer (0 to drain everything).
+@param token Token used to cancel the producer.
+@return The consumer task.
+*/
+RangeTask ConsumeRange(RangeStream<uint64_t> &stream, uint64_t step, uint64_t &sum, size_t &maxBuffered, int stopAfter, RangeCancelToken token) {
+    int taken = 0;
+    while (true) {
+        maxBuffered = std::max(maxBuffered, stream.Size());
+        std::optional<Range<uint64_t>> batch = co_await stream.Next();
+        if (!batch) break;
+        for (uint64_t v : GenerateRange(*batch, step)) sum += v;
+        if (++taken == stopAfter) { token.Cancel(); stream.Close(); break; }
+    }
+}
+
 int main() {
     ///////////////////////// Test 1: Basic Range Usage ////////////////////////////////
     Range<int> range1(1, 5);
@@ -95,5 +183,188 @@ int main() {
     TestPassed(10, "Test Iterator Operations");
     ///////////////////////////////////////////////////////////////////////////////////
 
+    ///////////////////////// Test 11: Empty Ranges and Disjoint Operations /////////////
+    Range<int> range6(10, 20);
+    Range<int> zeroRange(0, 0);
+    std::cout << "Intersection of Range1 and Range6: " << range1.Intersection(range6) << std::endl;
+    std::cout << "Difference between Range1 and Range6: " << (range1 - range6) << std::endl;
+    if (!range1.Intersection(range6).IsEmpty() || !range1.Union(range6).IsEmpty()) TestFailed(11, "Empty Ranges and Disjoint Operations");
+    if (range1.Intersection(range6) == zeroRange || zeroRange.IsEmpty()) TestFailed(11, "Empty Ranges and Disjoint Operations");
+    if ((range1 - range6) != range1 || (range1 - range3) != Range<int>(1, 3) || !((range1 - range3) && range3).IsEmpty()) TestFailed(11, "Empty Ranges and Disjoint Operations");
+    if (!(range3 - Range<int>(0, 9)).IsEmpty()) TestFailed(11, "Empty Ranges and Disjoint Operations");
+
+    Range<int> upperRest = Range<int>::EmptyRange();
+    if (range2.Difference(Range<int>(3, 6), upperRest) != Range<int>(0, 2) || upperRest != Range<int>(7, 10)) TestFailed(11, "Empty Ranges and Disjoint Operations");
+    if (range2.Difference(Range<int>(0, 6), upperRest) != Range<int>(7, 10) || !upperRest.IsEmpty()) TestFailed(11, "Empty Ranges and Disjoint Operations");
+    Range<unsigned> emptyRange = Range<unsigned>(1, 5).Intersection(Range<unsigned>(10, 20));
+    if (emptyRange.Begin != 0 || emptyRange.End != 0 || emptyRange.length() != 0) TestFailed(11, "Empty Ranges and Disjoint Operations");
+    if (!Range<unsigned>(1, 5).Union(Range<unsigned>(10, 20)).equal(emptyRange) || Range<unsigned>(1, 5).Difference(Range<unsigned>(0, 9)).length() != 0) TestFailed(11, "Empty Ranges and Disjoint Operations");
+    emptyRange.ChangeEnd(30);
+    emptyRange.MoveBegin(3);
+    if (!emptyRange.IsEmpty() || emptyRange.End != 0 || emptyRange.Begin != 0) TestFailed(11, "Empty Ranges and Disjoint Operations");
+    Range<int> emptyInts = range1.Intersection(range6);
+    if (!(emptyRange < Range<unsigned>(7, 8)) || emptyInts.begin() != emptyInts.end()) TestFailed(11, "Empty Ranges and Disjoint Operations");
+    TestPassed(11, "Empty Ranges and Disjoint Operations");
+    ///////////////////////////////////////////////////////////////////////////////////
+
+    ///////////////////////// Test 12: Randomized Property Test ////////////////////////
+    std::mt19937_64 rng(2077);
+    bool propertiesHold = RangePropertyCheck<int8_t>(rng, 20000) && RangePropertyCheck<uint8_t>(rng, 20000)
+        && RangePropertyCheck<int16_t>(rng, 20000) && RangePropertyCheck<uint16_t>(rng, 20000)
+        && RangePropertyCheck<int32_t>(rng, 20000) && RangePropertyCheck<uint32_t>(rng, 20000)
+        && RangePropertyCheck<int64_t>(rng, 20000) && RangePropertyCheck<uint64_t>(rng, 20000);
+    if (!propertiesHold) TestFailed(12, "Randomized Property Test");
+    TestPassed(12, "Randomized Property Test");
+    ///////////////////////////////////////////////////////////////////////////////////
+
+    ///////////////////////// Test 13: Coroutine Generators ////////////////////////////
+    std::cout << "Generating Range2 with step 3: ";
+    for (int v : GenerateRange(range2, 3)) std::cout << v << " ";
+    std::cout << std::endl;
+    std::cout << "Batches of 4 from Range2: ";
+    for (Range<int> batch : GenerateBatches(range2, 4)) std::cout << batch << " ";
+    std::cout << std::endl;
+
+    uint64_t top = std::numeric_limits<uint64_t>::max();
+    int topCount = 0;
+    for (Range<uint64_t> batch : GenerateBatches(Range<uint64_t>(top - 9, top), 4, 2)) topCount += (int)(batch.length() / 2 + 1);
+    RangeCancelToken generatorToken;
+    int generated = 0;
+    bool inOrder = true;
+    for (int v : GenerateRange(Range<int>(0, 1000), 1, generatorToken)) {
+        inOrder = inOrder && v == generated;
+        if (++generated == 5) generatorToken.Cancel();
+    }
+    int fullMin = std::numeric_limits<int>::min(), fullMax = std::numeric_limits<int>::max();
+    int fullBatches = 0;
+    bool fullWidth = true;
+    for (Range<int> batch : GenerateBatches(Range<int>(fullMin, fullMax), 2000000000, 3)) { fullWidth = fullWidth && batch == Range<int>(fullMin, fullMax); fullBatches++; }
+    int smallBatches = 0;
+    for (Range<int> batch : GenerateBatches(Range<int>(fullMin, fullMax), 1000000000, 3)) fullWidth = fullWidth && (smallBatches++ == 0 ? batch.Begin == fullMin : batch.End == fullMax);
+    int invalidYields = 0;
+    for (int v : GenerateRange(range2, 0)) { (void)v; invalidYields++; }
+    for (int v : GenerateRange(range2, -2)) { (void)v; invalidYields++; }
+    for (Range<int> batch : GenerateBatches(range2, 0)) { (void)batch; invalidYields++; }
+    for (Range<int> batch : GenerateBatches(range2, 4, 0)) { (void)batch; invalidYields++; }
+    if (invalidYields != 0) TestFailed(13, "Coroutine Generators");
+    if (topCount != 5 || generated != 5 || !inOrder || !fullWidth || fullBatches != 1 || smallBatches != 2) TestFailed(13, "Coroutine Generators");
+    TestPassed(13, "Coroutine Generators");
+    ///////////////////////////////////////////////////////////////////////////////////
+
+    ///////////////////////// Test 14: Backpressured Async Streams //////////////////////
+    RangeEventLoop loop;
+    RangeStream<uint64_t> stream(loop, 2);
+    uint64_t streamSum = 0;
+    size_t maxBuffered = 0;
+    RangeCancelToken streamToken;
+    RangeTask producer = ProduceRange(stream, Range<uint64_t>(1, 1000), 16, 1, streamToken);
+    RangeTask consumer = ConsumeRange(stream, 1, streamSum, maxBuffered, 0, streamToken);
+    producer.Start(loop);
+    consumer.Start(loop);
+    loop.Run();
+    std::cout << "Sum of streamed Range(1, 1000): " << streamSum << ", max buffered batches: " << maxBuffered << std::endl;
+    if (!producer.Done() || !consumer.Done() || streamSum != 500500 || maxBuffered > 2) TestFailed(14, "Backpressured Async Streams");
+
+    RangeStream<uint64_t> cancelledStream(loop, 2);
+    uint64_t cancelledSum = 0;
+    RangeCancelToken cancelToken;
+    RangeTask cancelledProducer = ProduceRange(cancelledStream, Range<uint64_t>(0, top), 10, 1, cancelToken);
+    RangeTask cancellingConsumer = ConsumeRange(cancelledStream, 1, cancelledSum, maxBuffered, 3, cancelToken);
+    cancelledProducer.Start(loop);
+    cancellingConsumer.Start(loop);
+    loop.Run();
+    std::cout << "Sum before cancelling Range(0, max): " << cancelledSum << std::endl;
+    if (!cancelledProducer.Done() || !cancellingConsumer.Done() || cancelledSum != 435) TestFailed(14, "Backpressured Async Streams");
+    TestPassed(14, "Backpressured Async Streams");
+    ///////////////////////////////////////////////////////////////////////////////////
+
+    ///////////////////////// Test 15: Range Bucketing and Partitioned Sort /////////////
+    std::vector<Range<int>> boundaries = {Range<int>(0, 9), Range<int>(10, 99), Range<int>(150, 199), Range<int>(200, 999)};
+    RangeBuckets<int> buckets(boundaries);
+    int rejected = 0;
+    try { RangeBuckets<int> overlapping({Range<int>(0, 10), Range<int>(10, 20)}); } catch (const std::invalid_argument &) { rejected++; }
+    try { RangeBuckets<int> unsorted({Range<int>(10, 20), Range<int>(0, 5)}); } catch (const std::invalid_argument &) { rejected++; }
+    try { RangeBuckets<int> withEmpty({Range<int>(0, 5), Range<int>::EmptyRange()}); } catch (const std::invalid_argument &) { rejected++; }
+    std::vector<int> samples(200000);
+    for (int &v : samples) v = (int)(rng() % 1200) - 100;
+
+    std::vector<uint64_t> expected(boundaries.size() + 1, 0);
+    for (int v : samples) {
+        size_t b = 0;
+        while (b < boundaries.size() && !boundaries[b].IsContain(Range<int>(v, v))) b++;
+        expected[b]++;
+    }
+    std::vector<uint64_t> histogram = buckets.Histogram(samples.data(), samples.size(), 4);
+    RangePartition<int> sorted = buckets.PartitionSort(samples.data(), samples.size(), 4);
+    std::cout << "Histogram over " << samples.size() << " values:";
+    for (size_t b = 0; b < histogram.size(); b++) std::cout << " " << histogram[b];
+    std::cout << std::endl;
+
+    bool bucketsHold = histogram == expected && sorted.Values.size() == samples.size();
+    for (size_t b = 0; b < boundaries.size(); b++) {
+        bucketsHold = bucketsHold && sorted.BucketSize(b) == expected[b];
+        for (size_t i = 0; i < sorted.BucketSize(b); i++) bucketsHold = bucketsHold && boundaries[b].IsContain(Range<int>(sorted.BucketData(b)[i], sorted.BucketData(b)[i]));
+    }
+    bucketsHold = bucketsHold && std::is_sorted(sorted.Values.begin(), sorted.Values.begin() + sorted.Offsets[boundaries.size()]);
+    // Batch classification (the SIMD path when built with -mavx2) must agree with Classify, including the type's edges
+    RangeBuckets<uint32_t> wideBuckets({Range<uint32_t>(0, 0), Range<uint32_t>(5, 0x7fffffff), Range<uint32_t>(0x80000000u, 0xfffffff0u), Range<uint32_t>(0xfffffffeu, 0xffffffffu)});
+    std::vector<uint32_t> wideValues(1000);
+    for (uint32_t &v : wideValues) v = (rng() & 1) ? (uint32_t)rng() : (uint32_t)(rng() % 8) + ((rng() & 1) ? 0xfffffff0u : 0u);
+    std::vector<uint32_t> wideIds(wideValues.size());
+    wideBuckets.ClassifyBatch(wideValues.data(), wideValues.size(), wideIds.data());
+    for (size_t i = 0; i < wideValues.size(); i++) bucketsHold = bucketsHold && wideIds[i] == wideBuckets.Classify(wideValues[i]);
+
+    if (!bucketsHold || rejected != 3 || buckets.Classify(150) != 2 || buckets.Boundary(3) != boundaries[3]) TestFailed(15, "Range Bucketing and Partitioned Sort");
+    TestPassed(15, "Range Bucketing and Partitioned Sort");
+    ///////////////////////////////////////////////////////////////////////////////////
+
+    ///////////////////////// Test 16: Compact Range Encoding //////////////////////////
+    std::vector<Range<uint64_t>> nacks;
+    uint64_t seq = 1000;
+    for (int i = 0; i < 1000; i++) {
+        seq += rng() % ((i % 50 == 0) ? 100000 : 60);  // Mostly short gaps with occasional long jumps
+        uint64_t len = rng() % 8;
+        nacks.push_back(Range<uint64_t>(seq, seq + len));
+        seq += len;
+    }
+    std::vector<uint8_t> encoded(RangeEncodedBound<uint64_t>(nacks.size()));
+    size_t encodedSize = RangeEncode(nacks.data(), nacks.size(), encoded.data(), encoded.size());
+    std::cout << "Encoded " << nacks.size() << " ranges into " << encodedSize << " bytes" << std::endl;
+
+    std::vector<Range<int32_t>> signedRanges = {Range<int32_t>(std::numeric_limits<int32_t>::min(), -5), Range<int32_t>(-3, 0), Range<int32_t>(7, std::numeric_limits<int32_t>::max())};
+    std::vector<Range<uint8_t>> byteRanges = {Range<uint8_t>(0, 0), Range<uint8_t>(3, 200), Range<uint8_t>(255, 255)};
+    bool codecHolds = RangeCodecRoundTrip(nacks) && RangeCodecRoundTrip(signedRanges) && RangeCodecRoundTrip(byteRanges)
+        && RangeCodecRoundTrip(std::vector<Range<int64_t>>{}) && encodedSize < nacks.size() * 3;
+
+    Range<uint64_t> truncated(0, 0);
+    RangeDecoder<uint64_t> truncatedDecoder(encoded.data(), encodedSize - 1);
+    size_t truncatedCount = 0;
+    while (truncatedDecoder.Next(truncated)) truncatedCount++;
+    codecHolds = codecHolds && truncatedDecoder.IsIncomplete() && !truncatedDecoder.IsError() && truncatedCount == nacks.size() - 1;
+    codecHolds = codecHolds && truncatedDecoder.Consumed() < encodedSize - 1 && RangeEncode(nacks.data(), nacks.size(), encoded.data(), encodedSize - 1) == 0;
+    // Chunked arrival: feed 5 bytes at a time, carrying the unconsumed tail into the next buffer
+    std::vector<uint8_t> pending;
+    std::vector<Range<uint64_t>> chunked;
+    Range<uint64_t> chunkRange(0, 0);
+    RangeDecoder<uint64_t> chunkDecoder(nullptr, 0);
+    for (size_t pos = 0; pos < encodedSize; pos += 5) {
+        pending.insert(pending.end(), encoded.begin() + pos, encoded.begin() + std::min(pos + 5, encodedSize));
+        chunkDecoder.Feed(pending.data(), pending.size());
+        while (chunkDecoder.Next(chunkRange)) chunked.push_back(chunkRange);
+        pending.erase(pending.begin(), pending.begin() + chunkDecoder.Consumed());
+    }
+    codecHolds = codecHolds && !chunkDecoder.IsError() && !chunkDecoder.IsIncomplete() && pending.empty() && chunked.size() == nacks.size();
+    for (size_t i = 0; codecHolds && i < nacks.size(); i++) codecHolds = chunked[i] == nacks[i];
+
+    const uint8_t overlong[] = {0x00, 0xff, 0x7f};  // Length 0x3fff does not fit in uint8_t
+    const uint8_t widest[] = {0x00, 0xff, 0x01};    // Length 0xff is the widest uint8_t value
+    Range<uint8_t> byteRange(0, 0);
+    RangeDecoder<uint8_t> overlongDecoder(overlong, sizeof(overlong)), widestDecoder(widest, sizeof(widest));
+    codecHolds = codecHolds && !overlongDecoder.Next(byteRange) && overlongDecoder.IsError();
+    codecHolds = codecHolds && widestDecoder.Next(byteRange) && byteRange == Range<uint8_t>(0, 255) && !widestDecoder.IsError();
+    if (!codecHolds) TestFailed(16, "Compact Range Encoding");
+    TestPassed(16, "Compact Range Encoding");
+    ///////////////////////////////////////////////////////////////////////////////////
+
     return 0;
 }